@@ -0,0 +1,156 @@
+#include "formula.h"
+/*
+
+本模块实现基数约束（至多k个 / 恰好k个文字为真）及其传播
+每个基数约束维护为真、为假文字的计数器，赋值时按文字的监视表更新计数器，
+计数器变化的约束进入队列，由 card_propagation() 统一推出文字
+
+*/
+
+//文字在监视表中的下标
+static int card_watch_index(Literal literal) {
+    return literal > 0 ? 2 * literal : -2 * literal + 1;
+}
+
+//基数约束初始化
+Cardinality* create_cardinality(Literal* literals, int length, int bound, int exact) {
+    Cardinality* card = (Cardinality*)malloc(sizeof(Cardinality));
+    card->literals = (Literal*)malloc(length * sizeof(Literal));
+    memcpy(card->literals, literals, length * sizeof(Literal));
+    card->length = length;
+    card->bound = bound;
+    card->exact = exact;
+    card->true_count = 0;
+    card->false_count = 0;
+    card->queued = 0;
+    card->next = NULL;
+    return card;
+}
+
+static void enqueue_card(Formula* formula, Cardinality* card) {
+    if (card->queued) return;
+    card->queued = 1;
+    formula->card_queue[formula->card_queue_count++] = card;
+}
+
+//添加基数约束
+void add_cardinality(Formula* formula, Cardinality* card) {
+    formula->card_count++;
+    card->next = formula->cards;
+    formula->cards = card;
+
+    // 首次使用时分配监视表
+    if (!formula->card_watch) {
+        formula->card_watch = (Cardinality***)calloc(2 * (formula->var_count + 1), sizeof(Cardinality**));
+        formula->card_watch_count = (int*)calloc(2 * (formula->var_count + 1), sizeof(int));
+    }
+
+    for (int i = 0; i < card->length; i++) {
+        int index = card_watch_index(card->literals[i]);
+        formula->card_watch_count[index]++;
+        formula->card_watch[index] = (Cardinality**)realloc(formula->card_watch[index],
+                formula->card_watch_count[index] * sizeof(Cardinality*));
+        formula->card_watch[index][formula->card_watch_count[index] - 1] = card;
+    }
+
+    // 已有赋值计入计数器
+    for (int i = 0; i < card->length; i++) {
+        Literal lit = card->literals[i];
+        int value = formula->assignment[abs(lit)];
+        if (value == 0) continue;
+        if (value == (lit > 0 ? 1 : -1)) {
+            card->true_count++;
+        } else {
+            card->false_count++;
+        }
+    }
+
+    // 队列容量随约束数量增长，新约束入队以便在根节点检查
+    formula->card_queue = (Cardinality**)realloc(formula->card_queue, formula->card_count * sizeof(Cardinality*));
+    enqueue_card(formula, card);
+}
+
+//文字被赋为真后更新计数器，约束被违反时返回0
+int update_card_counts(Formula* formula, Literal literal) {
+    int result = 1;
+
+    int index = card_watch_index(literal);
+    for (int i = 0; i < formula->card_watch_count[index]; i++) {
+        Cardinality* card = formula->card_watch[index][i];
+        card->true_count++;
+        if (card->true_count > card->bound) result = 0;
+        enqueue_card(formula, card);
+    }
+
+    index = card_watch_index(-literal);
+    for (int i = 0; i < formula->card_watch_count[index]; i++) {
+        Cardinality* card = formula->card_watch[index][i];
+        card->false_count++;
+        if (card->exact && card->length - card->false_count < card->bound) result = 0;
+        enqueue_card(formula, card);
+    }
+
+    return result;
+}
+
+//清空待传播队列（回溯时计数器已恢复到队列为空的状态）
+void clear_card_queue(Formula* formula) {
+    for (int i = 0; i < formula->card_queue_count; i++) {
+        formula->card_queue[i]->queued = 0;
+    }
+    formula->card_queue_count = 0;
+}
+
+//所有子句满足后，把基数约束中仍未赋值的文字赋为假（输出时未赋值变元一律按假，可能使文字为真）
+//某个约束因此被违反时返回0
+int complete_card_assignment(Formula* formula) {
+    for (Cardinality* card = formula->cards; card != NULL; card = card->next) {
+        for (int i = 0; i < card->length; i++) {
+            Literal lit = card->literals[i];
+            if (formula->assignment[abs(lit)] != 0) continue;
+            if (!assign_literal(formula, -lit)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+//基数约束传播：为真的文字达到上界时其余文字取假，恰好约束中可能为真的文字恰为k个时全部取真
+//推出的文字数量写入implied，发生冲突返回0
+int card_propagation(Formula* formula, int* implied) {
+    *implied = 0;
+
+    while (formula->card_queue_count > 0) {
+        Cardinality* card = formula->card_queue[--formula->card_queue_count];
+        card->queued = 0;
+
+        if (card->true_count > card->bound ||
+            (card->exact && card->length - card->false_count < card->bound)) {
+            return 0; // 冲突
+        }
+
+        int unassigned = card->length - card->true_count - card->false_count;
+        if (unassigned == 0) continue;
+
+        Literal forced_sign;
+        if (card->true_count == card->bound) {
+            forced_sign = -1; // 其余文字取假
+        } else if (card->exact && card->length - card->false_count == card->bound) {
+            forced_sign = 1;  // 其余文字取真
+        } else {
+            continue;
+        }
+
+        for (int i = 0; i < card->length; i++) {
+            Literal lit = card->literals[i];
+            if (formula->assignment[abs(lit)] != 0) continue;
+            if (!assign_literal(formula, forced_sign * lit)) {
+                return 0; // 冲突
+            }
+            (*implied)++;
+        }
+    }
+
+    return 1;
+}
@@ -5,6 +5,40 @@
 
 */
 
+//解析基数约束行："k <= k值 文字... 0" 表示至多k个为真，"k = k值 文字... 0" 表示恰好k个为真，格式错误返回0
+static int parse_cardinality_line(Formula* formula, char* line) {
+    char op[4];
+    int bound, offset;
+    if (sscanf(line, "k %3s %d%n", op, &bound, &offset) != 2) return 0;
+    
+    int exact;
+    if (strcmp(op, "<=") == 0) {
+        exact = 0;
+    } else if (strcmp(op, "=") == 0) {
+        exact = 1;
+    } else {
+        return 0;
+    }
+    if (bound < 0) return 0;
+    
+    Clause* literals = create_clause();
+    char* token = strtok(line + offset, " \t\n");
+    while (token != NULL) {
+        int value = atoi(token);
+        if (value == 0) break;
+        add_literal(literals, value);
+        token = strtok(NULL, " \t\n");
+    }
+    
+    // 没有文字的约束：至多约束或下界为0的恰好约束恒成立，可以丢弃；否则保留下来使公式不可满足
+    if (literals->length > 0 || (exact && bound > 0)) {
+        add_cardinality(formula, create_cardinality(literals->literals, literals->length, bound, exact));
+    }
+    free(literals->literals);
+    free(literals);
+    return 1;
+}
+
 //读取cnf文件
 Formula* parse_cnf(const char* filename) {
     FILE* file = fopen(filename, "r");
@@ -38,6 +72,19 @@ Formula* parse_cnf(const char* filename) {
     Clause* current_clause = create_clause();
     while (fgets(line, sizeof(line), file)) {
         if (line[0] == 'c') continue; // 跳过注释行
+        if (line[0] == 'k') {
+            // 基数约束行
+            if (!parse_cardinality_line(formula, line)) {
+                // 与 -verify 一致，格式错误时不求解，以免求解的是另一个公式
+                printf("基数约束行格式错误：%s", line);
+                free(current_clause->literals);
+                free(current_clause);
+                destroy_formula(formula);
+                fclose(file);
+                return NULL;
+            }
+            continue;
+        }
         
         char* token = strtok(line, " \t\n");
         while (token != NULL) {
@@ -83,6 +130,24 @@ Formula* create_formula(int var_count) {
     // 初始化监视表
     formula->watch = (Clause**)calloc(var_count + 1, sizeof(Clause*));
     formula->watch_count = (int*)calloc(var_count + 1, sizeof(int));
+    formula->xor_system = NULL;
+    
+    // 基数约束在首次添加时分配监视表
+    formula->card_count = 0;
+    formula->cards = NULL;
+    formula->card_watch = NULL;
+    formula->card_watch_count = NULL;
+    formula->card_queue = NULL;
+    formula->card_queue_count = 0;
+    
+    // 探测默认关闭，由调用者设置 next_probe 开启
+    formula->equiv = (int*)calloc(var_count + 1, sizeof(int));
+    formula->decisions = 0;
+    formula->next_probe = -1;
+    formula->probe_cursor = 0;
+    formula->probe_backoff = 0;
+    formula->probed_count = 0;
+    formula->substituted_count = 0;
     
     return formula;
 }
@@ -100,12 +165,31 @@ void destroy_formula(Formula* formula) {
         current = next;
     }
     
+    // 释放所有基数约束
+    Cardinality* card = formula->cards;
+    while (card != NULL) {
+        Cardinality* next = card->next;
+        free(card->literals);
+        free(card);
+        card = next;
+    }
+    if (formula->card_watch) {
+        for (int i = 0; i < 2 * (formula->var_count + 1); i++) {
+            free(formula->card_watch[i]);
+        }
+    }
+    free(formula->card_watch);
+    free(formula->card_watch_count);
+    free(formula->card_queue);
+    
     // 释放数组
     free(formula->assignment);
     free(formula->decision_level);
     free(formula->activity);
     free(formula->watch);
     free(formula->watch_count);
+    free(formula->equiv);
+    destroy_xor_system(formula->xor_system);
     
     free(formula);
 }
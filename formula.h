@@ -18,6 +18,34 @@ typedef struct Clause {
     struct Clause* next; // 指向下一个子句
 } Clause;
 
+// 基数约束结构：至多bound个文字为真（exact非0时恰好bound个）
+typedef struct Cardinality {
+    Literal* literals;  // 文字数组
+    int length;         // 文字个数
+    int bound;          // 上界k
+    int exact;          // 是否为恰好k个
+    int true_count;     // 当前为真的文字数
+    int false_count;    // 当前为假的文字数
+    int queued;         // 是否已在待传播队列中
+    struct Cardinality* next; // 指向下一个基数约束
+} Cardinality;
+
+// 异或约束系统：每行表示 变元异或和 = 右端项，按64位字打包，供高斯消元使用
+// 矩阵在各次传播之间保持消元后的形式（行变换不改变解集，回溯时无需恢复）
+typedef struct {
+    int row_count;      // 异或约束数量
+    int col_count;      // 涉及的变元数量
+    int words;          // 每行占用的64位字数
+    unsigned long long* rows; // 系数矩阵（行优先打包，已部分消元）
+    unsigned char* rhs; // 右端项
+    int* col_var;       // 列 -> 变元
+    int* var_col;       // 变元 -> 列 (-1表示不在任何异或约束中)
+    int* row_pivot;     // 行 -> 主元列 (-1表示无主元)，主元列只出现在本行
+    int* col_pivot;     // 列 -> 以其为主元的行 (-1表示非主元列)
+    unsigned long long* unassigned_mask; // 未赋值列掩码
+    unsigned long long* true_mask;       // 取真列掩码
+} XorSystem;
+
 // 公式结构（CNF）
 typedef struct {
     int var_count;      // 变元数量
@@ -28,6 +56,20 @@ typedef struct {
     double* activity;   // VSIDS活动度数组
     Clause** watch;     // 监视文字表
     int* watch_count;   // 每个变元的监视子句数量
+    XorSystem* xor_system; // 异或约束系统 (NULL表示未启用)
+    int card_count;     // 基数约束数量
+    Cardinality* cards; // 基数约束链表头指针
+    Cardinality*** card_watch; // 文字 -> 含该文字的基数约束表
+    int* card_watch_count;     // 每个文字的基数约束数量
+    Cardinality** card_queue;  // 计数器变化后待传播的基数约束
+    int card_queue_count;      // 待传播的基数约束数量
+    int* equiv;         // 被替换变元 -> 代表文字 (0表示未被替换)
+    int decisions;      // 决策次数
+    int next_probe;     // 下次探测的决策次数 (-1表示不探测)
+    int probe_cursor;   // 下次探测开始的变元位置
+    int probe_backoff;  // 连续无收获的探测轮数（探测间隔按2的幂放大）
+    int probed_count;   // 探测推出的文字总数
+    int substituted_count; // 被替换的变元总数
 } Formula;
 
 // 数独游戏结构
@@ -39,8 +81,35 @@ typedef struct {
     int* assignment;
     int* marked;
     int marked_count;
+    int* card_counts;   // 每个基数约束的 true_count, false_count
 } FormulaState;
 
+// 数独对称变换：变换后(r,c)处的数字 = digit[源网格(row[r], col[c])]，transpose为真时先转置源网格
+typedef struct {
+    int transpose;      // 是否转置
+    int row[9];         // 变换后第r行取自源网格第row[r]行
+    int col[9];         // 变换后第c列取自源网格第col[c]列
+    int digit[10];      // 数字重标号 (digit[0]恒为0)
+} SudokuTransform;
+
+// 数独解缓存项（键为规范形谜题或原谜题）
+typedef struct CacheEntry {
+    int is_percent;     // 规则集
+    int result;         // 1-有解, 0-无解
+    char puzzle[81];    // 谜题
+    char solution[81];  // 谜题的解
+    struct CacheEntry* next; // 同一哈希桶中的下一项
+} CacheEntry;
+
+// 数独解缓存（链地址哈希表）
+typedef struct {
+    CacheEntry** buckets; // 哈希桶
+    int bucket_count;   // 桶数量
+    int entry_count;    // 缓存项数量
+    int hits;           // 命中次数
+    int misses;         // 未命中次数
+} SudokuCache;
+
 
 
 //--------------函数声明--------------
@@ -51,6 +120,21 @@ int dpll(Formula* formula);
 int unit_propagation(Formula* formula);
 int assign_literal(Formula* formula, Literal literal);
 int choose_branch_variable(Formula* formula);
+//基数约束
+Cardinality* create_cardinality(Literal* literals, int length, int bound, int exact);
+void add_cardinality(Formula* formula, Cardinality* card);
+int card_propagation(Formula* formula, int* implied);
+int update_card_counts(Formula* formula, Literal literal);
+void clear_card_queue(Formula* formula);
+int complete_card_assignment(Formula* formula);
+//异或约束识别与高斯消元传播
+int detect_xor_constraints(Formula* formula);
+int xor_propagation(Formula* formula, int* implied);
+void destroy_xor_system(XorSystem* xor_system);
+//探测与等价文字替换
+int probe_formula(Formula* formula);
+int probe_if_due(Formula* formula);
+void reconstruct_model(Formula* formula);
 //状态存，取，释放
 FormulaState* save_formula_state(Formula* formula);
 void restore_formula_state(Formula* formula, FormulaState* state);
@@ -68,7 +152,25 @@ void decode_sudoku_var(int var, int* i, int* j, int* k);
 Formula* sudoku_to_formula(Sudoku* sudoku, int is_percent);
 void print_sudoku(Sudoku* sudoku);
 Sudoku* read_sudoku(const char* filename);
+int read_sudoku_list(const char* filename, Sudoku** puzzles);
+//数独规范化与解缓存
+void canonicalize_sudoku(Sudoku* sudoku, int is_percent, Sudoku* canonical, SudokuTransform* transform);
+void apply_sudoku_transform(Sudoku* sudoku, SudokuTransform* transform, Sudoku* result);
+void restore_sudoku_transform(Sudoku* transformed, SudokuTransform* transform, Sudoku* result);
+SudokuCache* create_sudoku_cache(int bucket_count);
+void destroy_sudoku_cache(SudokuCache* cache);
+int sudoku_cache_lookup(SudokuCache* cache, Sudoku* canonical, int is_percent, Sudoku* solution);
+void sudoku_cache_insert(SudokuCache* cache, Sudoku* canonical, int is_percent, int result, Sudoku* solution);
+int load_sudoku_cache(SudokuCache* cache, const char* filename);
+int save_sudoku_cache(SudokuCache* cache, const char* filename);
+int solve_sudoku_cached(Sudoku* sudoku, int is_percent, SudokuCache* cache, int* from_cache);
+//批量数独同步求解内核
+const char* solve_sudoku_bulk(Sudoku* puzzles, int count, int is_percent, int* results, int* fallback_count);
+//结果校验
+int verify_result(const char* cnf_file, const char* res_file);
 //结果保存
 void save_result(const char* filename, int result, Formula* formula, double time_ms);
+void save_sudoku_result(const char* filename, int result, Sudoku* sudoku, double time_ms);
+void save_batch_result(const char* filename, int count, int* results, Sudoku* puzzles, double time_ms);
 
 #endif
\ No newline at end of file
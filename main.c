@@ -4,9 +4,14 @@ int main(int argc, char* argv[]) {
     if (argc < 2) {
         printf("Usage: %s <mode> [options]\n", argv[0]);
         printf("Modes:\n");
-        printf("  -sat <cnf_file>        Solve SAT problem from CNF file\n");
-        printf("  -sudoku <sudoku_file>  Solve normal Sudoku\n");
-        printf("  -percent <sudoku_file> Solve Percent Sudoku\n");
+        printf("  -sat <cnf_file>                     Solve SAT problem from CNF file\n");
+        printf("  -sudoku <sudoku_file> [cache_file]  Solve normal Sudoku\n");
+        printf("  -percent <sudoku_file> [cache_file] Solve Percent Sudoku\n");
+        printf("  -batch <list_file> [cache_file]     Solve normal Sudoku puzzles, one per line\n");
+        printf("  -pbatch <list_file> [cache_file]    Solve Percent Sudoku puzzles, one per line\n");
+        printf("  -bulk <list_file> [-compare]        Solve normal Sudoku puzzles with the SIMD bulk kernel\n");
+        printf("  -pbulk <list_file> [-compare]       Solve Percent Sudoku puzzles with the SIMD bulk kernel\n");
+        printf("  -verify <cnf_file> <res_file>       Check the model in a result file\n");
         return 1;
     }
     
@@ -22,11 +27,21 @@ int main(int argc, char* argv[]) {
         }
         
         clock_t start = clock();
-        int result = dpll(formula);
+        // 先在根结点探测并替换等价文字，二元等价由替换处理后再识别异或约束
+        int result = unit_propagation(formula) && probe_formula(formula);
+        if (result) {
+            int xor_count = detect_xor_constraints(formula);
+            if (formula->xor_system) {
+                printf("Detected %d XOR constraints, Gaussian elimination enabled\n", xor_count);
+            }
+            result = dpll(formula);
+        }
         clock_t end = clock();
         double time_ms = ((double)(end - start)) * 1000 / CLOCKS_PER_SEC;
         
         printf("Result: %s\n", result ? "SATISFIABLE" : "UNSATISFIABLE");
+        printf("Probing: %d literals fixed, %d equivalent variables substituted\n",
+               formula->probed_count, formula->substituted_count);
         printf("Time: %.2f ms\n", time_ms);
         
         save_result(cnf_file, result, formula, time_ms);
@@ -35,6 +50,7 @@ int main(int argc, char* argv[]) {
     } else if ((strcmp(argv[1], "-sudoku") == 0 || strcmp(argv[1], "-percent") == 0) && argc >= 3) {
         // 数独求解模式
         const char* sudoku_file = argv[2];
+        const char* cache_file = argc >= 4 ? argv[3] : NULL;
         int is_percent = strcmp(argv[1], "-percent") == 0;
         
         printf("Solving %s from %s\n", is_percent ? "Percent Sudoku" : "Normal Sudoku", sudoku_file);
@@ -47,39 +63,140 @@ int main(int argc, char* argv[]) {
         
         print_sudoku(sudoku);
         
-        Formula* formula = sudoku_to_formula(sudoku, is_percent);
-        if (!formula) {
-            printf("Error: Failed to convert Sudoku to SAT\n");
-            free(sudoku);
-            return 1;
+        // 只有指定了缓存文件时才规范化并查缓存
+        SudokuCache* cache = NULL;
+        if (cache_file) {
+            cache = create_sudoku_cache(1024);
+            load_sudoku_cache(cache, cache_file);
         }
         
+        int from_cache = 0;
         clock_t start = clock();
-        int result = dpll(formula);
+        int result = solve_sudoku_cached(sudoku, is_percent, cache, &from_cache);
         clock_t end = clock();
         double time_ms = ((double)(end - start)) * 1000 / CLOCKS_PER_SEC;
         
         if (result) {
-            printf("Sudoku solved successfully!\n");
-            // 将SAT解转换为数独解
-            for (int i = 1; i <= formula->var_count; i++) {
-                if (formula->assignment[i] > 0) {
-                    int row, col, num;
-                    decode_sudoku_var(i, &row, &col, &num);
-                    sudoku->grid[row-1][col-1] = num;
-                }
-            }
+            printf("Sudoku solved successfully%s!\n", from_cache ? " (from cache)" : "");
             print_sudoku(sudoku);
         } else {
             printf("No solution found for the Sudoku\n");
         }
         
         printf("Time: %.2f ms\n", time_ms);
-        save_result(sudoku_file, result, formula, time_ms);
+        save_sudoku_result(sudoku_file, result, sudoku, time_ms);
         
-        destroy_formula(formula);
+        if (cache_file) {
+            save_sudoku_cache(cache, cache_file);
+        }
+        destroy_sudoku_cache(cache);
         free(sudoku);
         
+    } else if ((strcmp(argv[1], "-batch") == 0 || strcmp(argv[1], "-pbatch") == 0) && argc >= 3) {
+        // 批量数独求解模式
+        const char* list_file = argv[2];
+        const char* cache_file = argc >= 4 ? argv[3] : NULL;
+        int is_percent = strcmp(argv[1], "-pbatch") == 0;
+        
+        Sudoku* puzzles = NULL;
+        int count = read_sudoku_list(list_file, &puzzles);
+        if (count == 0) {
+            printf("Error: No puzzles found in %s\n", list_file);
+            free(puzzles);
+            return 1;
+        }
+        printf("Solving %d %s puzzles from %s\n", count, is_percent ? "Percent Sudoku" : "Normal Sudoku", list_file);
+        
+        SudokuCache* cache = create_sudoku_cache(count * 2 + 1);
+        if (cache_file) {
+            printf("Loaded %d cached puzzles from %s\n", load_sudoku_cache(cache, cache_file), cache_file);
+        }
+        
+        int* results = (int*)malloc(count * sizeof(int));
+        int solved = 0;
+        clock_t start = clock();
+        for (int n = 0; n < count; n++) {
+            results[n] = solve_sudoku_cached(&puzzles[n], is_percent, cache, NULL);
+            solved += results[n];
+        }
+        clock_t end = clock();
+        double time_ms = ((double)(end - start)) * 1000 / CLOCKS_PER_SEC;
+        
+        printf("Solved: %d / %d\n", solved, count);
+        printf("Cache hits: %d, misses: %d\n", cache->hits, cache->misses);
+        printf("Time: %.2f ms (%.2f puzzles/sec)\n", time_ms, time_ms > 0 ? count * 1000.0 / time_ms : 0.0);
+        save_batch_result(list_file, count, results, puzzles, time_ms);
+        
+        if (cache_file) {
+            save_sudoku_cache(cache, cache_file);
+        }
+        destroy_sudoku_cache(cache);
+        free(results);
+        free(puzzles);
+        
+    } else if ((strcmp(argv[1], "-bulk") == 0 || strcmp(argv[1], "-pbulk") == 0) && argc >= 3) {
+        // 批量数独同步求解模式
+        const char* list_file = argv[2];
+        int is_percent = strcmp(argv[1], "-pbulk") == 0;
+        int compare = argc >= 4 && strcmp(argv[3], "-compare") == 0;
+        
+        Sudoku* puzzles = NULL;
+        int count = read_sudoku_list(list_file, &puzzles);
+        if (count == 0) {
+            printf("Error: No puzzles found in %s\n", list_file);
+            free(puzzles);
+            return 1;
+        }
+        printf("Solving %d %s puzzles from %s\n", count, is_percent ? "Percent Sudoku" : "Normal Sudoku", list_file);
+        
+        // 对比模式下保留原谜题，稍后用 sudoku_to_formula() + dpll() 逐个求解
+        Sudoku* originals = NULL;
+        if (compare) {
+            originals = (Sudoku*)malloc(count * sizeof(Sudoku));
+            memcpy(originals, puzzles, count * sizeof(Sudoku));
+        }
+        
+        int* results = (int*)malloc(count * sizeof(int));
+        int fallback_count = 0;
+        clock_t start = clock();
+        const char* kernel = solve_sudoku_bulk(puzzles, count, is_percent, results, &fallback_count);
+        clock_t end = clock();
+        double time_ms = ((double)(end - start)) * 1000 / CLOCKS_PER_SEC;
+        
+        int solved = 0;
+        for (int n = 0; n < count; n++) {
+            solved += results[n];
+        }
+        printf("Kernel: %s\n", kernel);
+        printf("Solved: %d / %d (%d needed scalar backtracking)\n", solved, count, fallback_count);
+        printf("Time: %.2f ms (%.2f puzzles/sec)\n", time_ms, time_ms > 0 ? count * 1000.0 / time_ms : 0.0);
+        save_batch_result(list_file, count, results, puzzles, time_ms);
+        
+        if (compare) {
+            int mismatched = 0;
+            start = clock();
+            for (int n = 0; n < count; n++) {
+                mismatched += solve_sudoku_cached(&originals[n], is_percent, NULL, NULL) != results[n];
+            }
+            end = clock();
+            double dpll_ms = ((double)(end - start)) * 1000 / CLOCKS_PER_SEC;
+            printf("DPLL path: %.2f ms (%.2f puzzles/sec), %d results differ\n",
+                   dpll_ms, dpll_ms > 0 ? count * 1000.0 / dpll_ms : 0.0, mismatched);
+            printf("Speedup: %.2fx\n", time_ms > 0 ? dpll_ms / time_ms : 0.0);
+            free(originals);
+        }
+        
+        free(results);
+        free(puzzles);
+        
+    } else if (strcmp(argv[1], "-verify") == 0 && argc >= 4) {
+        // 结果校验模式
+        clock_t start = clock();
+        int verified = verify_result(argv[2], argv[3]);
+        clock_t end = clock();
+        printf("Time: %.2f ms\n", ((double)(end - start)) * 1000 / CLOCKS_PER_SEC);
+        return verified == 1 ? 0 : 1;
+        
     } else {
         printf("Invalid arguments\n");
         return 1;
@@ -114,3 +231,67 @@ void save_result(const char* filename, int result, Formula* formula, double time
     fclose(file);
     printf("Result saved to %s\n", res_filename);
 }
+
+
+//数独结果保存：按 sudoku_to_formula() 的变元编码输出，与SAT结果格式一致
+void save_sudoku_result(const char* filename, int result, Sudoku* sudoku, double time_ms) {
+    char res_filename[256];
+    strcpy(res_filename, filename);
+    char* dot = strrchr(res_filename, '.');
+    if (dot) *dot = '\0';
+    strcat(res_filename, ".res");
+    
+    FILE* file = fopen(res_filename, "w");
+    if (!file) {
+        printf("Error: Cannot create result file %s\n", res_filename);
+        return;
+    }
+    
+    fprintf(file, "s %d\n", result);
+    if (result == 1) {
+        fprintf(file, "v ");
+        for (int i = 1; i <= 9; i++) {
+            for (int j = 1; j <= 9; j++) {
+                for (int k = 1; k <= 9; k++) {
+                    int var = encode_sudoku_var(i, j, k);
+                    fprintf(file, "%d ", sudoku->grid[i-1][j-1] == k ? var : -var);
+                }
+            }
+        }
+        fprintf(file, "\n");
+    }
+    fprintf(file, "t %.2f\n", time_ms);
+    
+    fclose(file);
+    printf("Result saved to %s\n", res_filename);
+}
+
+//批量结果保存：每个谜题一行 "s 1 <81位解>" 或 "s 0"
+void save_batch_result(const char* filename, int count, int* results, Sudoku* puzzles, double time_ms) {
+    char res_filename[256];
+    strcpy(res_filename, filename);
+    char* dot = strrchr(res_filename, '.');
+    if (dot) *dot = '\0';
+    strcat(res_filename, ".res");
+    
+    FILE* file = fopen(res_filename, "w");
+    if (!file) {
+        printf("Error: Cannot create result file %s\n", res_filename);
+        return;
+    }
+    
+    for (int n = 0; n < count; n++) {
+        fprintf(file, "s %d", results[n]);
+        if (results[n] == 1) {
+            fprintf(file, " ");
+            for (int i = 0; i < 81; i++) {
+                fputc('0' + puzzles[n].grid[i / 9][i % 9], file);
+            }
+        }
+        fprintf(file, "\n");
+    }
+    fprintf(file, "t %.2f\n", time_ms);
+    
+    fclose(file);
+    printf("Result saved to %s\n", res_filename);
+}
@@ -0,0 +1,342 @@
+#include "formula.h"
+/*
+
+本模块实现探测与等价文字替换
+1. 失败文字探测：沿二元子句的蕴含图分别从变元的两个文字出发传播，一侧冲突则另一侧必然成立，两侧都推出的文字也必然成立
+2. 在二元子句的蕴含图上求强连通分量，同一分量中的文字相互等价
+3. 用分量代表文字替换其余文字，被替换的变元在求得模型后由代表文字还原
+
+*/
+
+#define PROBE_BUDGET 500     // 每次探测最多尝试的变元数
+#define PROBE_INTERVAL 1000  // 两次探测之间至少间隔的决策次数
+#define PROBE_MAX_BACKOFF 10 // 无收获时探测间隔最多放大到 PROBE_INTERVAL 的 2^10 倍
+
+// 二元子句的蕴含图（压缩邻接表）：结点n的后继为 edges[start[n]] ... edges[start[n + 1] - 1]
+typedef struct {
+    int nodes;          // 结点数（每个变元两个文字结点）
+    int* start;         // 每个结点的边在edges中的起始位置
+    int* edges;         // 后继结点
+} ImplicationGraph;
+
+//文字在蕴含图中的结点编号（x与¬x的结点编号只差最低位）
+static int literal_node(Literal literal) {
+    return literal > 0 ? 2 * literal : -2 * literal + 1;
+}
+
+static Literal node_literal(int node) {
+    return node % 2 ? -(node / 2) : node / 2;
+}
+
+//变元是否出现在基数约束或异或约束中（这些变元不参与替换）
+static int is_protected(Formula* formula, int var) {
+    if (formula->card_watch &&
+        (formula->card_watch_count[literal_node(var)] > 0 || formula->card_watch_count[literal_node(-var)] > 0)) {
+        return 1;
+    }
+    if (formula->xor_system && formula->xor_system->var_col[var] != -1) {
+        return 1;
+    }
+    return 0;
+}
+
+//由二元子句建立蕴含图：子句(a∨b)给出 ¬a→b 和 ¬b→a
+static void build_implication_graph(Formula* formula, ImplicationGraph* graph) {
+    int nodes = 2 * (formula->var_count + 1);
+    graph->nodes = nodes;
+    graph->start = (int*)calloc(nodes + 1, sizeof(int));
+    for (Clause* c = formula->clauses; c != NULL; c = c->next) {
+        if (c->length != 2 || abs(c->literals[0]) == abs(c->literals[1])) continue;
+        graph->start[literal_node(-c->literals[0]) + 1]++;
+        graph->start[literal_node(-c->literals[1]) + 1]++;
+    }
+    for (int i = 0; i < nodes; i++) {
+        graph->start[i + 1] += graph->start[i];
+    }
+
+    graph->edges = (int*)malloc((graph->start[nodes] + 1) * sizeof(int));
+    int* fill = (int*)malloc(nodes * sizeof(int));
+    memcpy(fill, graph->start, nodes * sizeof(int));
+    for (Clause* c = formula->clauses; c != NULL; c = c->next) {
+        if (c->length != 2 || abs(c->literals[0]) == abs(c->literals[1])) continue;
+        graph->edges[fill[literal_node(-c->literals[0])]++] = literal_node(c->literals[1]);
+        graph->edges[fill[literal_node(-c->literals[1])]++] = literal_node(c->literals[0]);
+    }
+    free(fill);
+}
+
+//从文字出发沿蕴含图广度优先传播，到达的未赋值结点在mark中记为stamp并依次写入queue
+//到达当前为假的文字或同时到达某文字及其否定时返回0（失败文字），否则返回1
+static int probe_literal(Formula* formula, ImplicationGraph* graph, Literal literal,
+                         int* mark, int stamp, int* queue, int* count) {
+    int head = 0, tail = 0;
+    int root = literal_node(literal);
+    mark[root] = stamp;
+    queue[tail++] = root;
+
+    while (head < tail) {
+        int u = queue[head++];
+        for (int e = graph->start[u]; e < graph->start[u + 1]; e++) {
+            int v = graph->edges[e];
+            if (mark[v] == stamp) continue;
+            if (mark[v ^ 1] == stamp) return 0; // 同时推出 l 与 ¬l
+
+            Literal lit = node_literal(v);
+            int value = formula->assignment[abs(lit)];
+            if (value != 0 && value != (lit > 0 ? 1 : -1)) return 0; // 推出为假的文字
+            mark[v] = stamp;
+            if (value == 0) {
+                queue[tail++] = v; // 已为真的文字其后继也已成立，不再展开
+            }
+        }
+    }
+    *count = tail;
+    return 1;
+}
+
+//对单个变元做失败文字探测，推出的文字直接赋值，返回 0-冲突（当前结点不可满足）, 1-正常
+static int probe_variable(Formula* formula, ImplicationGraph* graph, int var, int stamp,
+                          int* positive_mark, int* negative_mark, int* positive_queue, int* negative_queue, int* found) {
+    int positive_count, negative_count;
+    int positive_ok = probe_literal(formula, graph, var, positive_mark, stamp, positive_queue, &positive_count);
+    int negative_ok = probe_literal(formula, graph, -var, negative_mark, stamp, negative_queue, &negative_count);
+    if (!positive_ok && !negative_ok) {
+        return 0;
+    }
+
+    if (!positive_ok || !negative_ok) {
+        // 一侧失败，另一侧文字必然成立
+        (*found)++;
+        return assign_literal(formula, positive_ok ? var : -var);
+    }
+
+    // 两侧都推出的文字必然成立
+    for (int i = 1; i < positive_count; i++) {
+        int node = positive_queue[i];
+        if (negative_mark[node] != stamp) continue;
+        Literal lit = node_literal(node);
+        if (formula->assignment[abs(lit)] != 0) continue;
+        if (!assign_literal(formula, lit)) {
+            return 0;
+        }
+        (*found)++;
+    }
+    return 1;
+}
+
+//用非递归Tarjan算法求蕴含图的强连通分量，comp记录每个结点所属分量，返回分量数
+static int binary_implication_scc(ImplicationGraph* graph, int* comp) {
+    int nodes = graph->nodes;
+    int* start = graph->start;
+    int* edges = graph->edges;
+
+    int* index = (int*)malloc(nodes * sizeof(int));
+    int* low = (int*)malloc(nodes * sizeof(int));
+    int* on_stack = (int*)calloc(nodes, sizeof(int));
+    int* stack = (int*)malloc(nodes * sizeof(int));
+    int* call_node = (int*)malloc(nodes * sizeof(int));
+    int* call_edge = (int*)malloc(nodes * sizeof(int));
+    for (int i = 0; i < nodes; i++) {
+        index[i] = -1;
+    }
+
+    int counter = 0, stack_top = 0, comp_count = 0;
+    for (int root = 2; root < nodes; root++) {
+        if (index[root] != -1) continue;
+
+        int depth = 0;
+        call_node[0] = root;
+        call_edge[0] = start[root];
+        index[root] = low[root] = counter++;
+        stack[stack_top++] = root;
+        on_stack[root] = 1;
+
+        while (depth >= 0) {
+            int u = call_node[depth];
+            if (call_edge[depth] < start[u + 1]) {
+                int w = edges[call_edge[depth]++];
+                if (index[w] == -1) {
+                    index[w] = low[w] = counter++;
+                    stack[stack_top++] = w;
+                    on_stack[w] = 1;
+                    depth++;
+                    call_node[depth] = w;
+                    call_edge[depth] = start[w];
+                } else if (on_stack[w] && index[w] < low[u]) {
+                    low[u] = index[w];
+                }
+                continue;
+            }
+
+            // u的所有后继已处理完，若u为分量根则弹出整个分量
+            if (low[u] == index[u]) {
+                int w;
+                do {
+                    w = stack[--stack_top];
+                    on_stack[w] = 0;
+                    comp[w] = comp_count;
+                } while (w != u);
+                comp_count++;
+            }
+            depth--;
+            if (depth >= 0 && low[u] < low[call_node[depth]]) {
+                low[call_node[depth]] = low[u];
+            }
+        }
+    }
+
+    free(index);
+    free(low);
+    free(on_stack);
+    free(stack);
+    free(call_node);
+    free(call_edge);
+    return comp_count;
+}
+
+//把子句中的文字替换为代表文字，并去掉重复文字
+static void substitute_clause(Formula* formula, Clause* clause) {
+    int length = 0;
+    for (int i = 0; i < clause->length; i++) {
+        Literal lit = clause->literals[i];
+        int var = abs(lit);
+        if (formula->equiv[var] != 0) {
+            lit = lit > 0 ? formula->equiv[var] : -formula->equiv[var];
+        }
+
+        int duplicate = 0;
+        for (int j = 0; j < length; j++) {
+            if (clause->literals[j] == lit) {
+                duplicate = 1;
+                break;
+            }
+        }
+        if (!duplicate) {
+            clause->literals[length++] = lit;
+        }
+    }
+    clause->length = length;
+}
+
+//求等价文字并替换，返回 -1-发现 x 与 ¬x 等价（不可满足）, 否则返回被替换的变元数
+static int substitute_equivalences(Formula* formula, ImplicationGraph* graph) {
+    int* comp = (int*)malloc(graph->nodes * sizeof(int));
+    int comp_count = binary_implication_scc(graph, comp);
+
+    // 每个分量的代表文字：优先选受保护的变元，其次选编号最小的变元
+    Literal* rep = (Literal*)calloc(comp_count, sizeof(Literal));
+    for (int var = 1; var <= formula->var_count; var++) {
+        if (comp[literal_node(var)] == comp[literal_node(-var)]) {
+            free(comp);
+            free(rep);
+            return -1;
+        }
+        if (formula->equiv[var] != 0) continue;
+        for (int sign = 1; sign >= -1; sign -= 2) {
+            int c = comp[literal_node(sign * var)];
+            if (rep[c] == 0 || (is_protected(formula, var) && !is_protected(formula, abs(rep[c])))) {
+                rep[c] = sign * var;
+            }
+        }
+    }
+
+    int substituted = 0;
+    for (int var = 1; var <= formula->var_count; var++) {
+        if (formula->equiv[var] != 0 || is_protected(formula, var)) continue;
+        Literal r = rep[comp[literal_node(var)]];
+        if (abs(r) != var) {
+            formula->equiv[var] = r;
+            substituted++;
+        }
+    }
+
+    if (substituted > 0) {
+        for (Clause* c = formula->clauses; c != NULL; c = c->next) {
+            substitute_clause(formula, c);
+        }
+    }
+
+    free(comp);
+    free(rep);
+    return substituted;
+}
+
+//有界探测：失败文字探测后做等价文字替换，并安排下次探测，返回0表示当前结点冲突
+int probe_formula(Formula* formula) {
+    formula->next_probe = formula->decisions * 2 + (PROBE_INTERVAL << formula->probe_backoff);
+    ImplicationGraph graph;
+    build_implication_graph(formula, &graph);
+    int nodes = graph.nodes;
+    int* positive_mark = (int*)calloc(nodes, sizeof(int));
+    int* negative_mark = (int*)calloc(nodes, sizeof(int));
+    int* positive_queue = (int*)malloc(nodes * sizeof(int));
+    int* negative_queue = (int*)malloc(nodes * sizeof(int));
+
+    // 只探测在二元子句中出现的变元；从上次停下的位置继续，避免每次都探测同一批变元
+    int found = 0, ok = 1, probes = 0;
+    for (int n = 0; ok && probes < PROBE_BUDGET && n < formula->var_count; n++) {
+        int var = formula->probe_cursor % formula->var_count + 1;
+        formula->probe_cursor++;
+        if (formula->assignment[var] != 0 || formula->equiv[var] != 0) continue;
+        int positive = literal_node(var), negative = literal_node(-var);
+        if (graph.start[positive] == graph.start[positive + 1] && graph.start[negative] == graph.start[negative + 1]) continue;
+
+        probes++;
+        ok = probe_variable(formula, &graph, var, probes, positive_mark, negative_mark,
+                            positive_queue, negative_queue, &found);
+    }
+
+    free(positive_mark);
+    free(negative_mark);
+    free(positive_queue);
+    free(negative_queue);
+
+    // 推出的文字统一做一次单子句传播
+    int substituted = -1;
+    if (ok && (found == 0 || unit_propagation(formula))) {
+        substituted = substitute_equivalences(formula, &graph);
+    }
+    free(graph.start);
+    free(graph.edges);
+    if (substituted < 0) return 0;
+    formula->substituted_count += substituted;
+    formula->probed_count += found;
+
+    // 本轮既未推出文字也未发现等价文字时放大探测间隔，有收获时恢复
+    if (found == 0 && substituted == 0) {
+        if (formula->probe_backoff < PROBE_MAX_BACKOFF) {
+            formula->probe_backoff++;
+        }
+        formula->next_probe = formula->decisions * 2 + (PROBE_INTERVAL << formula->probe_backoff);
+    } else {
+        formula->probe_backoff = 0;
+    }
+
+    // 替换可能产生新的单子句
+    return substituted == 0 || unit_propagation(formula);
+}
+
+//搜索中按决策次数间隔重新触发探测
+int probe_if_due(Formula* formula) {
+    if (formula->next_probe < 0 || formula->decisions < formula->next_probe) {
+        return 1;
+    }
+    return probe_formula(formula);
+}
+
+//由代表文字还原被替换变元的取值，得到原公式的完整模型
+void reconstruct_model(Formula* formula) {
+    for (int var = 1; var <= formula->var_count; var++) {
+        if (formula->equiv[var] == 0) continue;
+
+        Literal r = formula->equiv[var];
+        while (formula->equiv[abs(r)] != 0) {
+            r = r > 0 ? formula->equiv[abs(r)] : -formula->equiv[abs(r)];
+        }
+        if (formula->assignment[abs(r)] == 0) {
+            formula->assignment[abs(r)] = -1; // 未赋值变元按假输出
+        }
+        int value = formula->assignment[abs(r)];
+        formula->assignment[var] = r > 0 ? value : -value;
+    }
+}
@@ -10,6 +10,11 @@ int dpll(Formula* formula) {
         return 0; // 冲突
     }
     
+    // 按间隔做探测与等价文字替换
+    if (!probe_if_due(formula)) {
+        return 0; // 冲突
+    }
+    
     // 检查是否所有子句都已满足
     int all_satisfied = 1;
     Clause* current = formula->clauses;
@@ -21,7 +26,25 @@ int dpll(Formula* formula) {
         current = current->next;
     }
     
+    // 恰好约束还需达到下界（至多约束的违反已在赋值时检出）
+    for (Cardinality* card = formula->cards; all_satisfied && card != NULL; card = card->next) {
+        if (card->exact && card->true_count < card->bound) {
+            all_satisfied = 0;
+        }
+    }
+    
+    // 基数约束中未赋值的文字需取假，否则输出的模型可能违反约束；补全失败则继续搜索
+    if (all_satisfied && formula->card_count > 0) {
+        FormulaState* state = save_formula_state(formula);
+        if (!complete_card_assignment(formula)) {
+            restore_formula_state(formula, state);
+            all_satisfied = 0;
+        }
+        free_formula_state(state);
+    }
+    
     if (all_satisfied) {
+        reconstruct_model(formula); // 还原被替换的变元
         return 1; // 可满足
     }
     
@@ -30,6 +53,7 @@ int dpll(Formula* formula) {
     if (var == 0) {
         return 0; // 没有未赋值的变量
     }
+    formula->decisions++;
     
     // 保存当前状态
     FormulaState* state = save_formula_state(formula);
@@ -90,6 +114,24 @@ int unit_propagation(Formula* formula) {
             }
             current = current->next;
         }//依次遍历每一个子句
+        
+        //子句传播到不动点后，处理计数器发生变化的基数约束
+        if (!changed && formula->card_queue_count > 0) {
+            int implied = 0;
+            if (!card_propagation(formula, &implied)) {
+                return 0; // 冲突
+            }
+            changed = implied > 0;
+        }
+        
+        //再由异或约束的高斯消元继续推出文字
+        if (!changed && formula->xor_system) {
+            int implied = 0;
+            if (!xor_propagation(formula, &implied)) {
+                return 0; // 冲突
+            }
+            changed = implied > 0;
+        }
     } while (changed);//每次变化之后从第一个子句重新开始寻找单子句传播
     
     return 1;
@@ -105,9 +147,15 @@ int assign_literal(Formula* formula, Literal literal) {
         return 0; // 冲突
     }
     
+    int newly_assigned = formula->assignment[var] == 0;
     formula->assignment[var] = value;
     formula->activity[var] += 1.0; // 更新VSIDS活动度
     
+    // 新赋值时更新基数约束计数器
+    if (newly_assigned && formula->card_count > 0) {
+        return update_card_counts(formula, literal);
+    }
+    
     return 1;
 }
 
@@ -117,7 +165,7 @@ int choose_branch_variable(Formula* formula) {
     int best_var = 0;
     
     for (int i = 1; i <= formula->var_count; i++) {
-        if (formula->assignment[i] == 0) { // 未赋值的变元
+        if (formula->assignment[i] == 0 && formula->equiv[i] == 0) { // 未赋值且未被替换的变元
             if (formula->activity[i] > max_score) {
                 max_score = formula->activity[i];
                 best_var = i;
@@ -157,6 +205,14 @@ FormulaState* save_formula_state(Formula* formula) {
         current = current->next;
     }
     
+    // 保存基数约束计数器
+    state->card_counts = (int*)malloc((2 * formula->card_count + 1) * sizeof(int));
+    i = 0;
+    for (Cardinality* card = formula->cards; card != NULL; card = card->next) {
+        state->card_counts[i++] = card->true_count;
+        state->card_counts[i++] = card->false_count;
+    }
+    
     return state;
 }
 
@@ -164,6 +220,7 @@ FormulaState* save_formula_state(Formula* formula) {
 void free_formula_state(FormulaState* state) {
     free(state->assignment);
     free(state->marked);
+    free(state->card_counts);
     free(state);
 }
 
@@ -179,5 +236,13 @@ void restore_formula_state(Formula* formula, FormulaState* state) {
         current->marked = state->marked[i++];
         current = current->next;
     }
+    
+    // 恢复基数约束计数器
+    i = 0;
+    for (Cardinality* card = formula->cards; card != NULL; card = card->next) {
+        card->true_count = state->card_counts[i++];
+        card->false_count = state->card_counts[i++];
+    }
+    clear_card_queue(formula);
 }
 
@@ -0,0 +1,275 @@
+#include "formula.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BULK_X86 1
+#endif
+/*
+
+本模块实现批量数独求解内核
+把 BULK_LANES 个谜题的候选数位图（每格9位）按格交错存放，一次处理所有谜题的同一格，
+在所有谜题上同步做唯余（格中只剩一个候选）和摒除（区域中某数字只剩一个位置）推理，
+推理卡住需要分支的谜题交给标量回溯求解
+运行时检测CPU：支持AVX2时一次处理16个谜题，否则x86用SSE2分两半处理，其它平台用可移植循环
+
+*/
+
+#define BULK_LANES 16     // 每批同步求解的谜题数
+#define ALL_CANDIDATES 0x1FF
+
+// 同步推理一轮：对所有区域做唯余与摒除，矛盾的谜题在bad中置非0，返回是否有候选发生变化
+typedef int (*BulkPropagate)(unsigned short cand[81][BULK_LANES], int units[][9], int unit_count, unsigned short* bad);
+
+//生成区域表：9行、9列、9宫，百分号数独另加两条对角线和两个窗口（与 sudoku_to_formula() 一致）
+static int build_units(int units[31][9], int is_percent) {
+    int count = 0;
+    for (int n = 0; n < 9; n++) {
+        for (int m = 0; m < 9; m++) {
+            units[count][m] = n * 9 + m;
+            units[count + 1][m] = m * 9 + n;
+            units[count + 2][m] = ((n / 3) * 3 + m / 3) * 9 + (n % 3) * 3 + m % 3;
+        }
+        count += 3;
+    }
+    if (is_percent) {
+        for (int m = 0; m < 9; m++) {
+            units[count][m] = m * 9 + (8 - m);
+            units[count + 1][m] = m * 9 + m;
+            units[count + 2][m] = (1 + m / 3) * 9 + 1 + m % 3;
+            units[count + 3][m] = (5 + m / 3) * 9 + 5 + m % 3;
+        }
+        count += 4;
+    }
+    return count;
+}
+
+//可移植实现：第i格第l个谜题位于 cand[i * stride + l]，标量回溯时 stride = lanes = 1
+static int propagate_lanes(unsigned short* cand, int stride, int lanes, int units[][9], int unit_count, unsigned short* bad) {
+    int changed = 0;
+    for (int u = 0; u < unit_count; u++) {
+        for (int l = 0; l < lanes; l++) {
+            unsigned short once = 0, twice = 0, singles = 0, dup = 0;
+            for (int i = 0; i < 9; i++) {
+                unsigned short c = cand[units[u][i] * stride + l];
+                unsigned short single = (c & (c - 1)) == 0 ? c : 0;
+                dup |= singles & single;
+                singles |= single;
+                twice |= once & c;
+                once |= c;
+            }
+            unsigned short exactly = once & ~twice;
+            bad[l] |= dup | (once ^ ALL_CANDIDATES);
+
+            for (int i = 0; i < 9; i++) {
+                unsigned short* cell = &cand[units[u][i] * stride + l];
+                unsigned short c = *cell;
+                if ((c & (c - 1)) == 0) {
+                    bad[l] |= c == 0;
+                    continue;
+                }
+                unsigned short next = c & ~singles;
+                if (next & exactly) next &= exactly;
+                bad[l] |= next == 0;
+                if (next != c) {
+                    *cell = next;
+                    changed = 1;
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+#ifndef BULK_X86
+static int propagate_portable(unsigned short cand[81][BULK_LANES], int units[][9], int unit_count, unsigned short* bad) {
+    return propagate_lanes(&cand[0][0], BULK_LANES, BULK_LANES, units, unit_count, bad);
+}
+#else
+//SSE2实现：每个寄存器8个谜题，分两半处理
+static int propagate_sse2(unsigned short cand[81][BULK_LANES], int units[][9], int unit_count, unsigned short* bad) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i all = _mm_set1_epi16(ALL_CANDIDATES);
+    __m128i changed = zero;
+
+    for (int half = 0; half < BULK_LANES; half += 8) {
+        __m128i bad_v = _mm_loadu_si128((__m128i*)(bad + half));
+        for (int u = 0; u < unit_count; u++) {
+            __m128i c[9];
+            __m128i once = zero, twice = zero, singles = zero, dup = zero;
+            for (int i = 0; i < 9; i++) {
+                c[i] = _mm_loadu_si128((__m128i*)(cand[units[u][i]] + half));
+                __m128i is_single = _mm_cmpeq_epi16(_mm_and_si128(c[i], _mm_sub_epi16(c[i], one)), zero);
+                __m128i single = _mm_and_si128(c[i], is_single);
+                dup = _mm_or_si128(dup, _mm_and_si128(singles, single));
+                singles = _mm_or_si128(singles, single);
+                twice = _mm_or_si128(twice, _mm_and_si128(once, c[i]));
+                once = _mm_or_si128(once, c[i]);
+            }
+            __m128i exactly = _mm_andnot_si128(twice, once);
+            bad_v = _mm_or_si128(bad_v, _mm_or_si128(dup, _mm_xor_si128(once, all)));
+
+            for (int i = 0; i < 9; i++) {
+                __m128i is_single = _mm_cmpeq_epi16(_mm_and_si128(c[i], _mm_sub_epi16(c[i], one)), zero);
+                __m128i reduced = _mm_andnot_si128(singles, c[i]);
+                __m128i hidden = _mm_and_si128(reduced, exactly);
+                __m128i no_hidden = _mm_cmpeq_epi16(hidden, zero);
+                reduced = _mm_or_si128(_mm_and_si128(no_hidden, reduced), _mm_andnot_si128(no_hidden, hidden));
+                __m128i next = _mm_or_si128(_mm_and_si128(is_single, c[i]), _mm_andnot_si128(is_single, reduced));
+                bad_v = _mm_or_si128(bad_v, _mm_cmpeq_epi16(next, zero));
+                changed = _mm_or_si128(changed, _mm_xor_si128(next, c[i]));
+                _mm_storeu_si128((__m128i*)(cand[units[u][i]] + half), next);
+            }
+        }
+        _mm_storeu_si128((__m128i*)(bad + half), bad_v);
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(changed, zero)) != 0xFFFF;
+}
+
+//AVX2实现：一个寄存器容纳全部16个谜题
+__attribute__((target("avx2")))
+static int propagate_avx2(unsigned short cand[81][BULK_LANES], int units[][9], int unit_count, unsigned short* bad) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i all = _mm256_set1_epi16(ALL_CANDIDATES);
+    __m256i changed = zero;
+    __m256i bad_v = _mm256_loadu_si256((__m256i*)bad);
+
+    for (int u = 0; u < unit_count; u++) {
+        __m256i c[9];
+        __m256i once = zero, twice = zero, singles = zero, dup = zero;
+        for (int i = 0; i < 9; i++) {
+            c[i] = _mm256_loadu_si256((__m256i*)cand[units[u][i]]);
+            __m256i is_single = _mm256_cmpeq_epi16(_mm256_and_si256(c[i], _mm256_sub_epi16(c[i], one)), zero);
+            __m256i single = _mm256_and_si256(c[i], is_single);
+            dup = _mm256_or_si256(dup, _mm256_and_si256(singles, single));
+            singles = _mm256_or_si256(singles, single);
+            twice = _mm256_or_si256(twice, _mm256_and_si256(once, c[i]));
+            once = _mm256_or_si256(once, c[i]);
+        }
+        __m256i exactly = _mm256_andnot_si256(twice, once);
+        bad_v = _mm256_or_si256(bad_v, _mm256_or_si256(dup, _mm256_xor_si256(once, all)));
+
+        for (int i = 0; i < 9; i++) {
+            __m256i is_single = _mm256_cmpeq_epi16(_mm256_and_si256(c[i], _mm256_sub_epi16(c[i], one)), zero);
+            __m256i reduced = _mm256_andnot_si256(singles, c[i]);
+            __m256i hidden = _mm256_and_si256(reduced, exactly);
+            reduced = _mm256_blendv_epi8(hidden, reduced, _mm256_cmpeq_epi16(hidden, zero));
+            __m256i next = _mm256_blendv_epi8(reduced, c[i], is_single);
+            bad_v = _mm256_or_si256(bad_v, _mm256_cmpeq_epi16(next, zero));
+            changed = _mm256_or_si256(changed, _mm256_xor_si256(next, c[i]));
+            _mm256_storeu_si256((__m256i*)cand[units[u][i]], next);
+        }
+    }
+    _mm256_storeu_si256((__m256i*)bad, bad_v);
+    return !_mm256_testz_si256(changed, changed);
+}
+#endif
+
+//运行时选择内核
+static BulkPropagate select_kernel(const char** name) {
+#ifdef BULK_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return propagate_avx2;
+    }
+    *name = "sse2";
+    return propagate_sse2;
+#else
+    *name = "portable";
+    return propagate_portable;
+#endif
+}
+
+//标量回溯：推理到不动点后选候选最少的格分支，返回是否有解
+static int solve_scalar(unsigned short* cand, int units[][9], int unit_count) {
+    unsigned short bad = 0;
+    while (propagate_lanes(cand, 1, 1, units, unit_count, &bad) && !bad) {}
+    if (bad) return 0;
+
+    int best = -1, best_count = 10;
+    for (int i = 0; i < 81; i++) {
+        int count = __builtin_popcount(cand[i]);
+        if (count > 1 && count < best_count) {
+            best = i;
+            best_count = count;
+        }
+    }
+    if (best == -1) return 1; // 每格只剩一个候选，且没有矛盾
+
+    for (unsigned short bits = cand[best]; bits; bits &= bits - 1) {
+        unsigned short copy[81];
+        memcpy(copy, cand, sizeof(copy));
+        copy[best] = bits & (~bits + 1);
+        if (solve_scalar(copy, units, unit_count)) {
+            memcpy(cand, copy, sizeof(copy));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void candidates_to_grid(unsigned short* cand, int stride, Sudoku* sudoku) {
+    for (int i = 0; i < 81; i++) {
+        sudoku->grid[i / 9][i % 9] = __builtin_ctz(cand[i * stride]) + 1;
+    }
+}
+
+//批量求解：解直接写回puzzles，结果写入results (1-有解, 0-无解)
+//返回内核名称，需要标量回溯的谜题数写入fallback_count
+const char* solve_sudoku_bulk(Sudoku* puzzles, int count, int is_percent, int* results, int* fallback_count) {
+    int units[31][9];
+    int unit_count = build_units(units, is_percent);
+    const char* name;
+    BulkPropagate propagate = select_kernel(&name);
+
+    unsigned short (*cand)[BULK_LANES] = (unsigned short (*)[BULK_LANES])malloc(81 * sizeof(*cand));
+    *fallback_count = 0;
+
+    for (int base = 0; base < count; base += BULK_LANES) {
+        int lanes = count - base < BULK_LANES ? count - base : BULK_LANES;
+        unsigned short bad[BULK_LANES] = {0};
+
+        // 装入候选位图，不足一批时空余的谜题填为全候选
+        for (int i = 0; i < 81; i++) {
+            for (int l = 0; l < BULK_LANES; l++) {
+                int v = l < lanes ? puzzles[base + l].grid[i / 9][i % 9] : 0;
+                cand[i][l] = v ? 1 << (v - 1) : ALL_CANDIDATES;
+            }
+        }
+
+        while (propagate(cand, units, unit_count, bad)) {}
+
+        for (int l = 0; l < lanes; l++) {
+            Sudoku* sudoku = &puzzles[base + l];
+            if (bad[l]) {
+                results[base + l] = 0;
+                continue;
+            }
+
+            int solved = 1;
+            for (int i = 0; i < 81 && solved; i++) {
+                solved = (cand[i][l] & (cand[i][l] - 1)) == 0;
+            }
+            if (solved) {
+                candidates_to_grid(&cand[0][l], BULK_LANES, sudoku);
+                results[base + l] = 1;
+                continue;
+            }
+
+            // 需要分支，从同步推理得到的候选状态开始标量回溯
+            unsigned short single[81];
+            for (int i = 0; i < 81; i++) {
+                single[i] = cand[i][l];
+            }
+            (*fallback_count)++;
+            results[base + l] = solve_scalar(single, units, unit_count);
+            if (results[base + l]) {
+                candidates_to_grid(single, 1, sudoku);
+            }
+        }
+    }
+
+    free(cand);
+    return name;
+}
@@ -0,0 +1,594 @@
+#include "formula.h"
+/*
+
+本模块实现数独的规范化与解缓存
+同构的谜题（数字重标号、带内行交换、带交换、栈内列交换、栈交换、转置）规范化后相同，
+缓存以规范形为键，同构的谜题规范化后即可命中；原谜题也作为键存入，完全重复的谜题无需规范化
+
+*/
+
+#define EMPTY_LABEL 10 // 规范化比较时空格排在所有数字之后，使数字多的行排在前面
+
+// 百分号数独中同时保持两条对角线和两个窗口不变的行列置换（行列施加同一置换）
+static const int percent_perms[4][9] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8},
+    {8, 7, 6, 5, 4, 3, 2, 1, 0},
+    {0, 2, 1, 3, 4, 5, 7, 6, 8},
+    {8, 6, 7, 5, 4, 3, 1, 2, 0}
+};
+
+// 规范化搜索状态
+typedef struct {
+    int grid[9][9];         // 当前（可能已转置的）源网格
+    int transpose;          // 当前是否转置
+    int col[9];             // 当前列排列
+    int row[9];             // 当前行排列
+    int stack[3];           // 每个输出栈对应的源栈
+    int used_col[9];        // 源列是否已使用
+    int used_stack[3];      // 源栈是否已使用
+    int band[3];            // 每个输出带对应的源带
+    int used_row[9];        // 源行是否已使用
+    int used_band[3];       // 源带是否已使用
+    unsigned char out[81];  // 当前部分规范形
+    unsigned char best[81]; // 目前最小的规范形
+    int have_best;          // 是否已有候选
+    SudokuTransform best_transform; // 最小规范形对应的变换
+} CanonSearch;
+
+//用数字映射重标号一行，返回扩展后的下一个标号
+static int relabel_row(CanonSearch* search, int src_row, int* digit, int next_label, unsigned char* row_out) {
+    for (int c = 0; c < 9; c++) {
+        int v = search->grid[src_row][search->col[c]];
+        if (v != 0 && digit[v] == 0) {
+            digit[v] = next_label++;
+        }
+        row_out[c] = (unsigned char)(v == 0 ? EMPTY_LABEL : digit[v]);
+    }
+    return next_label;
+}
+
+//逐行深度优先搜索：每层只沿取得最小行的候选继续，并用当前最优解剪枝
+static void canon_search_rows(CanonSearch* search, int r, int* digit, int next_label) {
+    if (r == 9) {
+        if (!search->have_best || memcmp(search->out, search->best, 81) < 0) {
+            memcpy(search->best, search->out, 81);
+            search->have_best = 1;
+            search->best_transform.transpose = search->transpose;
+            memcpy(search->best_transform.row, search->row, sizeof(search->row));
+            memcpy(search->best_transform.col, search->col, sizeof(search->col));
+            memcpy(search->best_transform.digit, digit, 10 * sizeof(int));
+        }
+        return;
+    }
+
+    // 收集候选源行
+    int candidates[9];
+    int candidate_count = 0;
+    if (r % 3 == 0) {
+        for (int b = 0; b < 3; b++) {
+            if (search->used_band[b]) continue;
+            for (int k = 0; k < 3; k++) {
+                candidates[candidate_count++] = b * 3 + k;
+            }
+        }
+    } else {
+        int b = search->band[r / 3];
+        for (int k = 0; k < 3; k++) {
+            if (!search->used_row[b * 3 + k]) {
+                candidates[candidate_count++] = b * 3 + k;
+            }
+        }
+    }
+
+    // 计算每个候选重标号后的行，找出最小行
+    unsigned char rows[9][9] = {{0}};
+    int digits[9][10];
+    int labels[9];
+    int min_index = 0;
+    for (int i = 0; i < candidate_count; i++) {
+        memcpy(digits[i], digit, 10 * sizeof(int));
+        labels[i] = relabel_row(search, candidates[i], digits[i], next_label, rows[i]);
+        if (memcmp(rows[i], rows[min_index], 9) < 0) {
+            min_index = i;
+        }
+    }
+
+    memcpy(search->out + r * 9, rows[min_index], 9);
+    if (search->have_best && memcmp(search->out, search->best, (r + 1) * 9) > 0) {
+        return; // 前缀已大于最优解，剪枝
+    }
+
+    for (int i = 0; i < candidate_count; i++) {
+        if (memcmp(rows[i], rows[min_index], 9) != 0) continue;
+
+        int s = candidates[i];
+        int b = s / 3;
+        int new_band = (r % 3 == 0);
+        if (new_band) {
+            search->used_band[b] = 1;
+            search->band[r / 3] = b;
+        }
+        search->used_row[s] = 1;
+        search->row[r] = s;
+        memcpy(search->out + r * 9, rows[i], 9);
+
+        canon_search_rows(search, r + 1, digits[i], labels[i]);
+
+        search->used_row[s] = 0;
+        if (new_band) {
+            search->used_band[b] = 0;
+        }
+    }
+}
+
+//以源行first为第一行，逐列确定列排列：每个位置只沿取得最小值的候选列继续，并用当前最优解剪枝
+//第一行完成后再对其余行做深度优先搜索
+static void canon_search_columns(CanonSearch* search, int first, int c, int* digit, int next_label) {
+    if (c == 9) {
+        memset(search->used_row, 0, sizeof(search->used_row));
+        memset(search->used_band, 0, sizeof(search->used_band));
+        search->used_row[first] = 1;
+        search->used_band[first / 3] = 1;
+        search->band[0] = first / 3;
+        search->row[0] = first;
+        canon_search_rows(search, 1, digit, next_label);
+        return;
+    }
+
+    // 收集候选源列：栈的第一列可取任一未用栈中的列，其余列取当前栈中未用的列
+    int candidates[9];
+    int candidate_count = 0;
+    if (c % 3 == 0) {
+        for (int st = 0; st < 3; st++) {
+            if (search->used_stack[st]) continue;
+            for (int k = 0; k < 3; k++) {
+                candidates[candidate_count++] = st * 3 + k;
+            }
+        }
+    } else {
+        int st = search->stack[c / 3];
+        for (int k = 0; k < 3; k++) {
+            if (!search->used_col[st * 3 + k]) {
+                candidates[candidate_count++] = st * 3 + k;
+            }
+        }
+    }
+
+    // 候选列在第一行上重标号后的取值，取最小值
+    int values[9];
+    int min_value = EMPTY_LABEL;
+    for (int i = 0; i < candidate_count; i++) {
+        int v = search->grid[first][candidates[i]];
+        values[i] = v == 0 ? EMPTY_LABEL : (digit[v] != 0 ? digit[v] : next_label);
+        if (values[i] < min_value) {
+            min_value = values[i];
+        }
+    }
+
+    search->out[c] = (unsigned char)min_value;
+    if (search->have_best && memcmp(search->out, search->best, c + 1) > 0) {
+        return; // 前缀已大于最优解，剪枝
+    }
+
+    for (int i = 0; i < candidate_count; i++) {
+        if (values[i] != min_value) continue;
+
+        int j = candidates[i];
+        int new_stack = (c % 3 == 0);
+        if (new_stack) {
+            search->used_stack[j / 3] = 1;
+            search->stack[c / 3] = j / 3;
+        }
+        search->used_col[j] = 1;
+        search->col[c] = j;
+
+        int next_digit[10];
+        memcpy(next_digit, digit, sizeof(next_digit));
+        int label = next_label;
+        int v = search->grid[first][j];
+        if (v != 0 && next_digit[v] == 0) {
+            next_digit[v] = label++;
+        }
+        search->out[c] = (unsigned char)min_value;
+        canon_search_columns(search, first, c + 1, next_digit, label);
+
+        search->used_col[j] = 0;
+        if (new_stack) {
+            search->used_stack[j / 3] = 0;
+        }
+    }
+}
+
+//行的形状：各栈中数字个数按降序排列后的编码，形状越大第一行的字典序越小
+static int row_shape(int grid[9][9], int r) {
+    int count[3] = {0};
+    for (int c = 0; c < 9; c++) {
+        if (grid[r][c] != 0) count[c / 3]++;
+    }
+    int high = count[0] > count[1] ? count[0] : count[1];
+    int low = count[0] > count[1] ? count[1] : count[0];
+    if (count[2] > high) {
+        return count[2] * 100 + high * 10 + low;
+    }
+    if (count[2] > low) {
+        return high * 100 + count[2] * 10 + low;
+    }
+    return high * 100 + low * 10 + count[2];
+}
+
+//普通数独：只有形状最优的行才可能成为第一行，以其为起点搜索列排列
+static void canon_normal(CanonSearch* search, int best_shape) {
+    for (int first = 0; first < 9; first++) {
+        if (row_shape(search->grid, first) != best_shape) continue;
+
+        int digit[10] = {0};
+        memset(search->used_col, 0, sizeof(search->used_col));
+        memset(search->used_stack, 0, sizeof(search->used_stack));
+        canon_search_columns(search, first, 0, digit, 1);
+    }
+}
+
+//百分号数独的对称群较小，直接枚举
+static void canon_percent(CanonSearch* search) {
+    for (int p = 0; p < 4; p++) {
+        int digit[10] = {0};
+        int next_label = 1;
+        memcpy(search->row, percent_perms[p], sizeof(search->row));
+        memcpy(search->col, percent_perms[p], sizeof(search->col));
+        for (int r = 0; r < 9; r++) {
+            next_label = relabel_row(search, search->row[r], digit, next_label, search->out + r * 9);
+        }
+        if (!search->have_best || memcmp(search->out, search->best, 81) < 0) {
+            memcpy(search->best, search->out, 81);
+            search->have_best = 1;
+            search->best_transform.transpose = search->transpose;
+            memcpy(search->best_transform.row, search->row, sizeof(search->row));
+            memcpy(search->best_transform.col, search->col, sizeof(search->col));
+            memcpy(search->best_transform.digit, digit, sizeof(digit));
+        }
+    }
+}
+
+//求数独在对称群下的规范形（字典序最小的重标号网格），并给出对应的变换
+void canonicalize_sudoku(Sudoku* sudoku, int is_percent, Sudoku* canonical, SudokuTransform* transform) {
+    CanonSearch* search = (CanonSearch*)malloc(sizeof(CanonSearch));
+    search->have_best = 0;
+
+    // 两种转置下所有行的最优形状（转置后的行即原网格的列）
+    int best_shape = 0;
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                search->grid[i][j] = t ? sudoku->grid[j][i] : sudoku->grid[i][j];
+            }
+            int shape = row_shape(search->grid, i);
+            if (shape > best_shape) {
+                best_shape = shape;
+            }
+        }
+    }
+
+    // 空网格的规范形即自身，无需搜索（所有列排列在第一行上都打平）
+    if (!is_percent && best_shape == 0) {
+        search->best_transform.transpose = 0;
+        for (int i = 0; i < 9; i++) {
+            search->best_transform.row[i] = i;
+            search->best_transform.col[i] = i;
+        }
+        memset(search->best_transform.digit, 0, sizeof(search->best_transform.digit));
+    }
+
+    for (int t = 0; t < 2 && (is_percent || best_shape > 0); t++) {
+        search->transpose = t;
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                search->grid[i][j] = t ? sudoku->grid[j][i] : sudoku->grid[i][j];
+            }
+        }
+        if (is_percent) {
+            canon_percent(search);
+        } else {
+            canon_normal(search, best_shape);
+        }
+    }
+
+    *transform = search->best_transform;
+
+    // 补全谜题中未出现的数字的标号，使变换可以作用于完整的解
+    int next_label = 1;
+    for (int v = 1; v <= 9; v++) {
+        if (transform->digit[v] >= next_label) {
+            next_label = transform->digit[v] + 1;
+        }
+    }
+    for (int v = 1; v <= 9; v++) {
+        if (transform->digit[v] == 0) {
+            transform->digit[v] = next_label++;
+        }
+    }
+    transform->digit[0] = 0;
+
+    apply_sudoku_transform(sudoku, transform, canonical);
+    free(search);
+}
+
+//对数独施加变换
+void apply_sudoku_transform(Sudoku* sudoku, SudokuTransform* transform, Sudoku* result) {
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            int i = transform->row[r];
+            int j = transform->col[c];
+            int v = transform->transpose ? sudoku->grid[j][i] : sudoku->grid[i][j];
+            result->grid[r][c] = transform->digit[v];
+        }
+    }
+    result->given_count = sudoku->given_count;
+}
+
+//撤销变换：由变换后的网格还原出源网格
+void restore_sudoku_transform(Sudoku* transformed, SudokuTransform* transform, Sudoku* result) {
+    int inverse_digit[10] = {0};
+    for (int v = 1; v <= 9; v++) {
+        inverse_digit[transform->digit[v]] = v;
+    }
+
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            int i = transform->row[r];
+            int j = transform->col[c];
+            int v = inverse_digit[transformed->grid[r][c]];
+            if (transform->transpose) {
+                result->grid[j][i] = v;
+            } else {
+                result->grid[i][j] = v;
+            }
+        }
+    }
+}
+
+//FNV-1a哈希
+static unsigned int hash_puzzle(const char* puzzle, int is_percent) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < 81; i++) {
+        hash ^= (unsigned char)puzzle[i];
+        hash *= 16777619u;
+    }
+    hash ^= (unsigned int)is_percent;
+    hash *= 16777619u;
+    return hash;
+}
+
+static void grid_to_chars(Sudoku* sudoku, char* chars) {
+    for (int i = 0; i < 81; i++) {
+        chars[i] = (char)('0' + sudoku->grid[i / 9][i % 9]);
+    }
+}
+
+static void chars_to_grid(const char* chars, Sudoku* sudoku) {
+    sudoku->given_count = 0;
+    for (int i = 0; i < 81; i++) {
+        sudoku->grid[i / 9][i % 9] = chars[i] - '0';
+        if (chars[i] != '0') sudoku->given_count++;
+    }
+}
+
+//缓存初始化
+SudokuCache* create_sudoku_cache(int bucket_count) {
+    SudokuCache* cache = (SudokuCache*)malloc(sizeof(SudokuCache));
+    cache->bucket_count = bucket_count;
+    cache->buckets = (CacheEntry**)calloc(bucket_count, sizeof(CacheEntry*));
+    cache->entry_count = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    return cache;
+}
+
+//删除缓存
+void destroy_sudoku_cache(SudokuCache* cache) {
+    if (!cache) return;
+
+    for (int b = 0; b < cache->bucket_count; b++) {
+        CacheEntry* current = cache->buckets[b];
+        while (current != NULL) {
+            CacheEntry* next = current->next;
+            free(current);
+            current = next;
+        }
+    }
+    free(cache->buckets);
+    free(cache);
+}
+
+static CacheEntry* find_entry(SudokuCache* cache, const char* puzzle, int is_percent) {
+    unsigned int b = hash_puzzle(puzzle, is_percent) % cache->bucket_count;
+    CacheEntry* current = cache->buckets[b];
+    while (current != NULL) {
+        if (current->is_percent == is_percent && memcmp(current->puzzle, puzzle, 81) == 0) {
+            return current;
+        }
+        current = current->next;
+    }
+    return NULL;
+}
+
+//查找规范形谜题，返回 -1-未命中, 0-无解, 1-有解（解写入solution）
+int sudoku_cache_lookup(SudokuCache* cache, Sudoku* canonical, int is_percent, Sudoku* solution) {
+    char puzzle[81];
+    grid_to_chars(canonical, puzzle);
+
+    CacheEntry* entry = find_entry(cache, puzzle, is_percent);
+    if (!entry) {
+        cache->misses++;
+        return -1;
+    }
+
+    cache->hits++;
+    if (entry->result == 1 && solution) {
+        chars_to_grid(entry->solution, solution);
+    }
+    return entry->result;
+}
+
+//把哈希表扩大到new_count个桶并重新分配所有项
+static void resize_sudoku_cache(SudokuCache* cache, int new_count) {
+    CacheEntry** buckets = (CacheEntry**)calloc(new_count, sizeof(CacheEntry*));
+    for (int b = 0; b < cache->bucket_count; b++) {
+        CacheEntry* current = cache->buckets[b];
+        while (current != NULL) {
+            CacheEntry* next = current->next;
+            unsigned int nb = hash_puzzle(current->puzzle, current->is_percent) % new_count;
+            current->next = buckets[nb];
+            buckets[nb] = current;
+            current = next;
+        }
+    }
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = new_count;
+}
+
+//插入谜题（规范形或原谜题）及其解（已存在则忽略），项数超过桶数时扩容
+void sudoku_cache_insert(SudokuCache* cache, Sudoku* canonical, int is_percent, int result, Sudoku* solution) {
+    char puzzle[81];
+    grid_to_chars(canonical, puzzle);
+    if (find_entry(cache, puzzle, is_percent)) return;
+
+    CacheEntry* entry = (CacheEntry*)malloc(sizeof(CacheEntry));
+    entry->is_percent = is_percent;
+    entry->result = result;
+    memcpy(entry->puzzle, puzzle, 81);
+    if (result == 1) {
+        grid_to_chars(solution, entry->solution);
+    } else {
+        memset(entry->solution, '0', 81);
+    }
+
+    unsigned int b = hash_puzzle(puzzle, is_percent) % cache->bucket_count;
+    entry->next = cache->buckets[b];
+    cache->buckets[b] = entry;
+    cache->entry_count++;
+
+    // 保持平均链长不超过1
+    if (cache->entry_count > cache->bucket_count) {
+        resize_sudoku_cache(cache, cache->bucket_count * 2 + 1);
+    }
+}
+
+//81个字符是否都是数字，allow_empty为0时不允许'0'（完整的解）
+static int is_grid_string(const char* chars, int allow_empty) {
+    for (int i = 0; i < 81; i++) {
+        if (chars[i] < (allow_empty ? '0' : '1') || chars[i] > '9') return 0;
+    }
+    return 1;
+}
+
+//从文件载入缓存，每行格式：<is_percent> <result> <谜题> <解>，返回载入的项数
+int load_sudoku_cache(SudokuCache* cache, const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        return 0; // 缓存文件不存在时从空缓存开始
+    }
+
+    char line[256];
+    int loaded = 0;
+    while (fgets(line, sizeof(line), file)) {
+        int is_percent, result;
+        char puzzle[82], solution[82];
+        if (sscanf(line, "%d %d %81s %81s", &is_percent, &result, puzzle, solution) != 4) continue;
+        if (strlen(puzzle) != 81 || strlen(solution) != 81) continue;
+        // 忽略损坏的行：取值越界的格会在还原变换时越界访问
+        if ((is_percent != 0 && is_percent != 1) || (result != 0 && result != 1)) continue;
+        if (!is_grid_string(puzzle, 1) || !is_grid_string(solution, result == 0)) continue;
+
+        Sudoku key, solved;
+        chars_to_grid(puzzle, &key);
+        chars_to_grid(solution, &solved);
+        sudoku_cache_insert(cache, &key, is_percent, result, &solved);
+        loaded++;
+    }
+
+    fclose(file);
+    return loaded;
+}
+
+//保存缓存到文件，返回 1-成功, 0-失败
+int save_sudoku_cache(SudokuCache* cache, const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        printf("Error: Cannot create cache file %s\n", filename);
+        return 0;
+    }
+
+    for (int b = 0; b < cache->bucket_count; b++) {
+        for (CacheEntry* current = cache->buckets[b]; current != NULL; current = current->next) {
+            fprintf(file, "%d %d %.81s %.81s\n", current->is_percent, current->result,
+                    current->puzzle, current->solution);
+        }
+    }
+
+    fclose(file);
+    return 1;
+}
+
+//直接用 sudoku_to_formula() + dpll() 求解，解写回sudoku
+static int solve_sudoku_directly(Sudoku* sudoku, int is_percent) {
+    Formula* formula = sudoku_to_formula(sudoku, is_percent);
+    int result = dpll(formula);
+    if (result) {
+        for (int i = 1; i <= formula->var_count; i++) {
+            if (formula->assignment[i] > 0) {
+                int row, col, num;
+                decode_sudoku_var(i, &row, &col, &num);
+                sudoku->grid[row-1][col-1] = num;
+            }
+        }
+    }
+    destroy_formula(formula);
+    return result;
+}
+
+//借助缓存求解数独，解直接写回sudoku；未命中时直接求解并写入缓存，cache为NULL时不使用缓存
+int solve_sudoku_cached(Sudoku* sudoku, int is_percent, SudokuCache* cache, int* from_cache) {
+    if (from_cache) *from_cache = 0;
+    if (!cache) {
+        return solve_sudoku_directly(sudoku, is_percent);
+    }
+
+    Sudoku original = *sudoku, canonical, solution;
+
+    // 先按原谜题查找，完全重复的谜题不必规范化
+    char puzzle[81];
+    grid_to_chars(sudoku, puzzle);
+    CacheEntry* entry = find_entry(cache, puzzle, is_percent);
+    if (entry) {
+        cache->hits++;
+        if (from_cache) *from_cache = 1;
+        if (entry->result == 1) {
+            chars_to_grid(entry->solution, sudoku);
+            sudoku->given_count = original.given_count;
+        }
+        return entry->result;
+    }
+
+    SudokuTransform transform;
+    canonicalize_sudoku(sudoku, is_percent, &canonical, &transform);
+
+    int result = sudoku_cache_lookup(cache, &canonical, is_percent, &solution);
+    if (result != -1) {
+        if (from_cache) *from_cache = 1;
+        if (result == 1) {
+            restore_sudoku_transform(&solution, &transform, sudoku);
+        }
+        sudoku_cache_insert(cache, &original, is_percent, result, sudoku);
+        return result;
+    }
+
+    result = solve_sudoku_directly(sudoku, is_percent);
+    if (result) {
+        apply_sudoku_transform(sudoku, &transform, &solution);
+    }
+
+    sudoku_cache_insert(cache, &canonical, is_percent, result, &solution);
+    sudoku_cache_insert(cache, &original, is_percent, result, sudoku);
+    return result;
+}
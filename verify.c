@@ -0,0 +1,273 @@
+#include "formula.h"
+/*
+
+本模块实现 .res 结果的流式校验（替代 verify.exe / verify5000.exe）
+先把 .res 中的 v 行读入位图，再单遍扫描CNF逐个检查子句，不建立 Formula 链表，
+遇到第一个不满足的子句或基数约束即报告其行号
+
+*/
+
+// 带缓冲的字符流，记录当前行号
+typedef struct {
+    FILE* file;
+    char buffer[1 << 16];
+    size_t length;
+    size_t pos;
+    int line;
+} StreamReader;
+
+static int next_char(StreamReader* reader) {
+    if (reader->pos == reader->length) {
+        reader->length = fread(reader->buffer, 1, sizeof(reader->buffer), reader->file);
+        reader->pos = 0;
+        if (reader->length == 0) return EOF;
+    }
+    int c = (unsigned char)reader->buffer[reader->pos++];
+    if (c == '\n') reader->line++;
+    return c;
+}
+
+//跳过当前行剩余部分
+static void skip_line(StreamReader* reader) {
+    int c;
+    do {
+        c = next_char(reader);
+    } while (c != '\n' && c != EOF);
+}
+
+//读取下一个记号的首字符（跳过空白）
+static int next_token_start(StreamReader* reader) {
+    int c;
+    do {
+        c = next_char(reader);
+    } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+    return c;
+}
+
+//从首字符c开始读取整数，读到非数字为止（该字符被消耗），格式错误返回0
+static int read_int(StreamReader* reader, int c, int* value, int* last) {
+    int sign = 1;
+    if (c == '-') {
+        sign = -1;
+        c = next_char(reader);
+    }
+    if (c < '0' || c > '9') return 0;
+
+    int v = 0;
+    while (c >= '0' && c <= '9') {
+        v = v * 10 + (c - '0');
+        c = next_char(reader);
+    }
+    *value = sign * v;
+    *last = c;
+    return 1;
+}
+
+// 模型位图：present 记录出现在 v 行中的变元，value 记录取真的变元
+typedef struct {
+    unsigned long long* present;
+    unsigned long long* value;
+    int capacity;       // 可容纳的变元数
+} ModelBits;
+
+static void model_set(ModelBits* model, int literal) {
+    int var = abs(literal);
+    if (var >= model->capacity) {
+        int capacity = model->capacity;
+        while (capacity <= var) capacity *= 2;
+        int old_words = model->capacity / 64, words = capacity / 64;
+        model->present = (unsigned long long*)realloc(model->present, words * sizeof(unsigned long long));
+        model->value = (unsigned long long*)realloc(model->value, words * sizeof(unsigned long long));
+        memset(model->present + old_words, 0, (words - old_words) * sizeof(unsigned long long));
+        memset(model->value + old_words, 0, (words - old_words) * sizeof(unsigned long long));
+        model->capacity = capacity;
+    }
+    model->present[var / 64] |= 1ULL << (var % 64);
+    if (literal > 0) {
+        model->value[var / 64] |= 1ULL << (var % 64);
+    } else {
+        model->value[var / 64] &= ~(1ULL << (var % 64));
+    }
+}
+
+//文字在模型下是否为真（模型中没有的变元视为未赋值）
+static int model_satisfies(ModelBits* model, int literal) {
+    int var = abs(literal);
+    if (var >= model->capacity) return 0;
+    unsigned long long bit = 1ULL << (var % 64);
+    if (!(model->present[var / 64] & bit)) return 0;
+    return ((model->value[var / 64] & bit) != 0) == (literal > 0);
+}
+
+//读取 .res 文件，返回 s 行的结果 (1/0)，没有有效的 s 行返回 -1，文件无法打开返回 -2
+static int load_model(const char* res_file, ModelBits* model) {
+    StreamReader* reader = (StreamReader*)malloc(sizeof(StreamReader));
+    reader->file = fopen(res_file, "r");
+    if (!reader->file) {
+        printf("Error: Cannot open result file %s\n", res_file);
+        free(reader);
+        return -2;
+    }
+    reader->length = reader->pos = 0;
+    reader->line = 1;
+
+    int result = -1;
+    int c = next_token_start(reader);
+    while (c != EOF) {
+        if (c == 's') {
+            int last;
+            if (!read_int(reader, next_token_start(reader), &result, &last)) break;
+            if (last != '\n') skip_line(reader);
+        } else if (c == 'v') {
+            // v 行可能很长，逐个读取文字
+            c = next_char(reader);
+            while (c != '\n' && c != EOF) {
+                if (c == '-' || (c >= '0' && c <= '9')) {
+                    int literal;
+                    if (!read_int(reader, c, &literal, &c)) break;
+                    if (literal != 0) model_set(model, literal);
+                } else {
+                    c = next_char(reader);
+                }
+            }
+            if (c == EOF) break;
+        } else {
+            skip_line(reader); // t 行及其它
+        }
+        c = next_token_start(reader);
+    }
+
+    fclose(reader->file);
+    free(reader);
+    return result;
+}
+
+//检查基数约束行 "k <= b 文字... 0" / "k = b 文字... 0"
+//返回 1-满足, 0-不满足, -1-格式错误（与 parse_cnf() 一样只接受 <= 和 = 以及非负的 b）
+static int check_cardinality_line(StreamReader* reader, ModelBits* model) {
+    int op = next_token_start(reader);
+    int exact = (op == '=');
+    int c = next_char(reader);
+    if (op == '<' && c == '=') {
+        c = next_char(reader);
+    } else if (!exact) {
+        op = 0;
+    }
+
+    int bound, true_count = 0;
+    if (op == 0 || (c != ' ' && c != '\t') ||
+        !read_int(reader, next_token_start(reader), &bound, &c) || bound < 0) {
+        if (c != '\n' && c != EOF) skip_line(reader);
+        return -1;
+    }
+    while (c != '\n' && c != EOF) {
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            int literal;
+            if (!read_int(reader, c, &literal, &c) || literal == 0) break;
+            true_count += model_satisfies(model, literal);
+        } else {
+            c = next_char(reader);
+        }
+    }
+    if (c != '\n' && c != EOF) skip_line(reader);
+
+    return exact ? true_count == bound : true_count <= bound;
+}
+
+//流式校验：返回 1-模型满足全部约束, 0-存在不满足的约束或结果为不可满足, -1-文件错误
+int verify_result(const char* cnf_file, const char* res_file) {
+    ModelBits model;
+    model.capacity = 1024;
+    model.present = (unsigned long long*)calloc(model.capacity / 64, sizeof(unsigned long long));
+    model.value = (unsigned long long*)calloc(model.capacity / 64, sizeof(unsigned long long));
+
+    int result = load_model(res_file, &model);
+    if (result != 1) {
+        if (result == 0) {
+            printf("Result file reports UNSATISFIABLE, no model to verify\n");
+        } else if (result == -1) {
+            printf("Error: No valid 's' line in %s\n", res_file);
+        }
+        free(model.present);
+        free(model.value);
+        return result == 0 ? 0 : -1;
+    }
+
+    StreamReader* reader = (StreamReader*)malloc(sizeof(StreamReader));
+    reader->file = fopen(cnf_file, "r");
+    if (!reader->file) {
+        printf("Error: Cannot open CNF file %s\n", cnf_file);
+        free(reader);
+        free(model.present);
+        free(model.value);
+        return -1;
+    }
+    reader->length = reader->pos = 0;
+    reader->line = 1;
+
+    int verified = 1;
+    int clause_count = 0;
+    int satisfied = 0;      // 当前子句是否已满足
+    int clause_line = 0;    // 当前子句开始的行号（0表示不在子句中）
+    int c = next_token_start(reader);
+    while (c != EOF) {
+        if (clause_line == 0 && (c == 'c' || c == 'p')) {
+            skip_line(reader); // 注释行与问题行
+        } else if (clause_line == 0 && c == '%') {
+            break; // 部分算例以 % 结束子句部分
+        } else if (clause_line == 0 && c == 'k') {
+            int line = reader->line;
+            clause_count++;
+            int checked = check_cardinality_line(reader, &model);
+            if (checked == -1) {
+                printf("Error: Malformed cardinality constraint at line %d of %s\n", line, cnf_file);
+                verified = -1;
+                break;
+            }
+            if (checked == 0) {
+                printf("FAILED: cardinality constraint at line %d is violated\n", line);
+                verified = 0;
+                break;
+            }
+        } else {
+            int literal;
+            if (!read_int(reader, c, &literal, &c)) {
+                printf("Error: Unexpected character at line %d of %s\n", reader->line, cnf_file);
+                verified = -1;
+                break;
+            }
+            if (clause_line == 0) {
+                clause_line = reader->line - (c == '\n');
+                satisfied = 0;
+            }
+            if (literal == 0) {
+                clause_count++;
+                if (!satisfied) {
+                    printf("FAILED: clause %d at line %d is falsified\n", clause_count, clause_line);
+                    verified = 0;
+                    break;
+                }
+                clause_line = 0;
+            } else if (!satisfied) {
+                satisfied = model_satisfies(&model, literal);
+            }
+            if (c == EOF) break;
+        }
+        c = next_token_start(reader);
+    }
+
+    // 文件末尾缺少结束符0的子句
+    if (verified == 1 && clause_line != 0 && !satisfied) {
+        printf("FAILED: clause %d at line %d is falsified\n", clause_count + 1, clause_line);
+        verified = 0;
+    }
+    if (verified == 1) {
+        printf("Verified: all %d constraints satisfied\n", clause_count);
+    }
+
+    fclose(reader->file);
+    free(reader);
+    free(model.present);
+    free(model.value);
+    return verified;
+}
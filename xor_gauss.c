@@ -0,0 +1,258 @@
+#include "formula.h"
+/*
+
+本模块识别CNF中以子句组编码的异或约束，并用高斯-约当消元在赋值过程中推出文字
+k元异或约束由 2^(k-1) 个覆盖相同变元、负文字个数奇偶性相同的子句编码
+消元是增量的：每行保持一个未赋值的主元列，只有主元被赋值的行才重新选主元并消去该列
+
+*/
+
+#define XOR_MAX_SIZE 6   // 识别的异或约束最大元数
+#define XOR_MIN_COUNT 8  // 识别出的异或约束不少于此数时启用高斯消元
+
+// 候选子句：按变元排序后的变元表与负文字位图
+typedef struct {
+    int length;                 // 变元个数
+    int vars[XOR_MAX_SIZE];     // 升序变元
+    int signs;                  // 第i位为1表示vars[i]以负文字出现
+} XorCandidate;
+
+static int candidate_parity(const XorCandidate* c) {
+    return __builtin_popcount(c->signs) & 1;
+}
+
+//按 长度、变元表、奇偶性、负文字位图 排序，使同一异或约束的子句相邻
+static int compare_candidates(const void* a, const void* b) {
+    const XorCandidate* x = (const XorCandidate*)a;
+    const XorCandidate* y = (const XorCandidate*)b;
+    if (x->length != y->length) return x->length - y->length;
+    for (int i = 0; i < x->length; i++) {
+        if (x->vars[i] != y->vars[i]) return x->vars[i] - y->vars[i];
+    }
+    if (candidate_parity(x) != candidate_parity(y)) return candidate_parity(x) - candidate_parity(y);
+    return x->signs - y->signs;
+}
+
+static int same_constraint(const XorCandidate* x, const XorCandidate* y) {
+    if (x->length != y->length || candidate_parity(x) != candidate_parity(y)) return 0;
+    return memcmp(x->vars, y->vars, x->length * sizeof(int)) == 0;
+}
+
+//把子句转成候选，长度不合适或含重复变元时返回0
+static int make_candidate(Clause* clause, XorCandidate* candidate) {
+    if (clause->length < 2 || clause->length > XOR_MAX_SIZE) return 0;
+
+    Literal lits[XOR_MAX_SIZE];
+    memcpy(lits, clause->literals, clause->length * sizeof(Literal));
+    for (int i = 1; i < clause->length; i++) {
+        Literal key = lits[i];
+        int j = i - 1;
+        while (j >= 0 && abs(lits[j]) > abs(key)) {
+            lits[j + 1] = lits[j];
+            j--;
+        }
+        lits[j + 1] = key;
+    }//按变元插入排序
+
+    candidate->length = clause->length;
+    candidate->signs = 0;
+    for (int i = 0; i < clause->length; i++) {
+        if (i > 0 && abs(lits[i]) == abs(lits[i - 1])) return 0;
+        candidate->vars[i] = abs(lits[i]);
+        if (lits[i] < 0) candidate->signs |= 1 << i;
+    }
+    return 1;
+}
+
+//根据识别出的异或约束建立打包矩阵
+static XorSystem* create_xor_system(Formula* formula, XorCandidate* xors, int* rhs, int xor_count) {
+    XorSystem* xs = (XorSystem*)malloc(sizeof(XorSystem));
+    xs->row_count = xor_count;
+    xs->var_col = (int*)malloc((formula->var_count + 1) * sizeof(int));
+    for (int v = 0; v <= formula->var_count; v++) {
+        xs->var_col[v] = -1;
+    }
+
+    // 为异或约束中出现的变元分配列
+    xs->col_count = 0;
+    xs->col_var = (int*)malloc((formula->var_count + 1) * sizeof(int));
+    for (int r = 0; r < xor_count; r++) {
+        for (int i = 0; i < xors[r].length; i++) {
+            int var = xors[r].vars[i];
+            if (xs->var_col[var] == -1) {
+                xs->var_col[var] = xs->col_count;
+                xs->col_var[xs->col_count++] = var;
+            }
+        }
+    }
+
+    xs->words = (xs->col_count + 63) / 64;
+    xs->rows = (unsigned long long*)calloc((size_t)xor_count * xs->words, sizeof(unsigned long long));
+    xs->rhs = (unsigned char*)malloc(xor_count);
+    xs->row_pivot = (int*)malloc(xor_count * sizeof(int));
+    xs->col_pivot = (int*)malloc(xs->col_count * sizeof(int));
+    xs->unassigned_mask = (unsigned long long*)malloc(xs->words * sizeof(unsigned long long));
+    xs->true_mask = (unsigned long long*)malloc(xs->words * sizeof(unsigned long long));
+
+    for (int r = 0; r < xor_count; r++) {
+        unsigned long long* row = xs->rows + (size_t)r * xs->words;
+        for (int i = 0; i < xors[r].length; i++) {
+            int c = xs->var_col[xors[r].vars[i]];
+            row[c / 64] |= 1ULL << (c % 64);
+        }
+        xs->rhs[r] = (unsigned char)rhs[r];
+        xs->row_pivot[r] = -1;
+    }
+    for (int c = 0; c < xs->col_count; c++) {
+        xs->col_pivot[c] = -1;
+    }
+
+    return xs;
+}
+
+//删除异或约束系统
+void destroy_xor_system(XorSystem* xs) {
+    if (!xs) return;
+
+    free(xs->rows);
+    free(xs->rhs);
+    free(xs->row_pivot);
+    free(xs->col_pivot);
+    free(xs->unassigned_mask);
+    free(xs->true_mask);
+    free(xs->col_var);
+    free(xs->var_col);
+    free(xs);
+}
+
+//识别异或约束，数量足够时为公式启用高斯消元，返回识别出的异或约束数量
+int detect_xor_constraints(Formula* formula) {
+    XorCandidate* candidates = (XorCandidate*)malloc((formula->clause_count + 1) * sizeof(XorCandidate));
+    int candidate_count = 0;
+    for (Clause* current = formula->clauses; current != NULL; current = current->next) {
+        if (make_candidate(current, &candidates[candidate_count])) {
+            candidate_count++;
+        }
+    }
+
+    qsort(candidates, candidate_count, sizeof(XorCandidate), compare_candidates);
+
+    // 扫描相邻的同组子句，统计不同的负文字位图
+    XorCandidate* xors = (XorCandidate*)malloc((candidate_count + 1) * sizeof(XorCandidate));
+    int* rhs = (int*)malloc((candidate_count + 1) * sizeof(int));
+    int xor_count = 0;
+    int start = 0;
+    while (start < candidate_count) {
+        int end = start + 1;
+        int distinct = 1;
+        while (end < candidate_count && same_constraint(&candidates[start], &candidates[end])) {
+            if (candidates[end].signs != candidates[end - 1].signs) distinct++;
+            end++;
+        }
+
+        // 禁止了某一奇偶性的全部赋值，即变元异或和等于另一奇偶性
+        if (distinct == 1 << (candidates[start].length - 1)) {
+            xors[xor_count] = candidates[start];
+            rhs[xor_count] = (candidate_parity(&candidates[start]) + 1) & 1;
+            xor_count++;
+        }
+        start = end;
+    }
+
+    if (xor_count >= XOR_MIN_COUNT) {
+        destroy_xor_system(formula->xor_system);
+        formula->xor_system = create_xor_system(formula, xors, rhs, xor_count);
+    }
+
+    free(candidates);
+    free(xors);
+    free(rhs);
+    return xor_count;
+}
+
+//以第r行的第c列为主元，从其它行中消去该列
+static void eliminate_column(XorSystem* xs, int r, int c) {
+    int words = xs->words;
+    int w = c / 64;
+    unsigned long long bit = 1ULL << (c % 64);
+    unsigned long long* pivot_row = xs->rows + (size_t)r * words;
+
+    xs->row_pivot[r] = c;
+    xs->col_pivot[c] = r;
+    for (int i = 0; i < xs->row_count; i++) {
+        unsigned long long* row = xs->rows + (size_t)i * words;
+        if (i != r && (row[w] & bit)) {
+            for (int k = 0; k < words; k++) {
+                row[k] ^= pivot_row[k];
+            }
+            xs->rhs[i] ^= xs->rhs[r];
+        }
+    }
+}
+
+//高斯-约当消元传播：主元已被赋值的行改选未赋值列为主元，使每个主元列只出现在本行
+//推出的文字直接赋值，数量写入implied；发生冲突返回0
+int xor_propagation(Formula* formula, int* implied) {
+    XorSystem* xs = formula->xor_system;
+    int words = xs->words;
+    *implied = 0;
+
+    memset(xs->unassigned_mask, 0, words * sizeof(unsigned long long));
+    memset(xs->true_mask, 0, words * sizeof(unsigned long long));
+    for (int c = 0; c < xs->col_count; c++) {
+        int value = formula->assignment[xs->col_var[c]];
+        if (value == 0) {
+            xs->unassigned_mask[c / 64] |= 1ULL << (c % 64);
+        } else if (value > 0) {
+            xs->true_mask[c / 64] |= 1ULL << (c % 64);
+        }
+    }
+
+    // 只处理主元失效的行：其它行的主元列不会出现在本行，新主元总是非主元列
+    for (int r = 0; r < xs->row_count; r++) {
+        int p = xs->row_pivot[r];
+        if (p != -1 && (xs->unassigned_mask[p / 64] & (1ULL << (p % 64)))) continue;
+        if (p != -1) {
+            xs->col_pivot[p] = -1;
+            xs->row_pivot[r] = -1;
+        }
+
+        unsigned long long* row = xs->rows + (size_t)r * words;
+        for (int w = 0; w < words; w++) {
+            unsigned long long free_bits = row[w] & xs->unassigned_mask[w];
+            if (free_bits) {
+                eliminate_column(xs, r, w * 64 + __builtin_ctzll(free_bits));
+                break;
+            }
+        }
+    }
+
+    // 检查每行：无未赋值变元时核对奇偶性，只剩一个未赋值变元时推出其取值
+    for (int r = 0; r < xs->row_count; r++) {
+        unsigned long long* row = xs->rows + (size_t)r * words;
+        int unassigned = 0;
+        int parity = xs->rhs[r];
+        int last_col = -1;
+        for (int w = 0; w < words; w++) {
+            unsigned long long free_bits = row[w] & xs->unassigned_mask[w];
+            if (free_bits) {
+                unassigned += __builtin_popcountll(free_bits);
+                last_col = w * 64 + __builtin_ctzll(free_bits);
+            }
+            parity ^= __builtin_popcountll(row[w] & xs->true_mask[w]) & 1;
+        }
+
+        if (unassigned == 0 && parity != 0) {
+            return 0; // 冲突
+        }
+        if (unassigned == 1) {
+            int var = xs->col_var[last_col];
+            if (!assign_literal(formula, parity ? var : -var)) {
+                return 0; // 冲突
+            }
+            (*implied)++;
+        }
+    }
+
+    return 1;
+}